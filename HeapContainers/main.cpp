@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "myHeap.h"
+#include "myHeapResource.hpp"
+
+// Puts standard containers on MyHeap through MyHeapResource.hpp.
+// The heap is tiny, so the containers are kept small.
+
+using SquareMap = std::map<int, int, std::less<int>, MyHeapAllocator<std::pair<int const, int>>>;
+
+void printStats(char const *when);
+
+int main()
+{
+    {
+        std::pmr::vector<std::uint64_t> values(myHeapResource());
+        for (std::uint64_t i = 0; i < 5; ++i)
+        {
+            values.push_back(i * 10);
+        }
+
+        SquareMap squares;
+        for (int i = 0; i < 3; ++i)
+        {
+            squares[i] = i * i;
+        }
+
+        std::printf("values[4] = %llu, squares[2] = %d\n", static_cast<unsigned long long>(values[4]), squares[2]);
+        printStats("With the containers");
+    }
+
+    printStats("After the containers are destroyed");
+
+    // Running out of heap throws instead of returning NULL
+    heapSetErrorReporting(false);
+    try
+    {
+        std::pmr::vector<char> tooLarge(heapGetSize() + 1, 'x', myHeapResource());
+        std::printf("Unexpectedly allocated %zu bytes.\n", tooLarge.size());
+        return EXIT_FAILURE;
+    }
+    catch (std::bad_alloc const &)
+    {
+        std::printf("A vector larger than the heap throws std::bad_alloc.\n");
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void printStats(char const *when)
+{
+    HeapStats const stats = heapGetStats();
+    std::printf("%s: %zu chunks, %zu bytes allocated, %zu bytes free.\n",
+                when, stats.chunkCount, stats.allocatedBytes, stats.freeBytes);
+}
@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitmapFactory.h"
+#include "eventLog.h"
+#include "macros.h"
+
+// Renders an event log written by MyMalloc as a heap occupancy over time image.
+// Each row is the state of the heap after an event, the first event at the top.
+
+// Maximum image height. Longer logs are sampled evenly.
+#define MAX_ROWS 4096
+
+typedef struct
+{
+    Event event;
+    // Position in the file, to keep the order of events with equal timestamps
+    size_t index;
+} IndexedEvent;
+
+IndexedEvent *readEvents(FILE *file, size_t *eventCount);
+int compareEvents(void const *left, void const *right);
+void applyEvent(uint8_t occupancy[], size_t heapSize, Event event);
+void drawRow(uint8_t *row, uint8_t const occupancy[], size_t heapSize);
+
+// Occupancy states
+enum
+{
+    BYTE_FREE,
+    BYTE_CHUNK_START,
+    BYTE_ALLOCATED,
+};
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <event log> <output bitmap>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *logFile = NULL;
+    if (fopen_s(&logFile, argv[1], "rb") != 0)
+    {
+        fprintf(stderr, "Could not open %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    EventLogHeader header;
+    if (fread(&header, sizeof header, 1, logFile) != 1
+        || !streqn(header.magic, EVENT_LOG_MAGIC, sizeof header.magic)
+        || header.version != EVENT_LOG_VERSION
+        || header.eventSize != sizeof(Event))
+    {
+        fprintf(stderr, "%s is not a supported event log.\n", argv[1]);
+        fclose(logFile);
+        return EXIT_FAILURE;
+    }
+
+    size_t eventCount;
+    IndexedEvent *const events = readEvents(logFile, &eventCount);
+    fclose(logFile);
+
+    if (events == NULL)
+    {
+        fprintf(stderr, "Could not read the events of %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    if (eventCount == 0)
+    {
+        fprintf(stderr, "%s contains no events.\n", argv[1]);
+        free(events);
+        return EXIT_FAILURE;
+    }
+
+    // Events are grouped by thread in the log
+    qsort(events, eventCount, sizeof *events, compareEvents);
+
+    size_t const heapSize = header.heapSize;
+    size_t const rowCount = MIN(eventCount, MAX_ROWS);
+    size_t const rowSize = heapSize * BYTES_PER_PIXEL;
+
+    uint8_t *const occupancy = calloc(heapSize, sizeof *occupancy);
+    uint8_t *const image = malloc(rowCount * rowSize);
+    if (occupancy == NULL || image == NULL)
+    {
+        fprintf(stderr, "Could not allocate a %zux%zu image.\n", heapSize, rowCount);
+        free(occupancy);
+        free(image);
+        free(events);
+        return EXIT_FAILURE;
+    }
+
+    size_t iEvent = 0;
+    for (size_t row = 0; row < rowCount; ++row)
+    {
+        // Replay events up to the last one this row represents
+        size_t const lastEvent = (row + 1) * eventCount / rowCount;
+        for (; iEvent < lastEvent; ++iEvent)
+        {
+            applyEvent(occupancy, heapSize, events[iEvent].event);
+        }
+
+        // Bitmaps are stored bottom-up
+        drawRow(image + (rowCount - 1 - row) * rowSize, occupancy, heapSize);
+    }
+
+    bool const success = generateBitmapImage(image, (uint32_t)rowCount, (uint32_t)heapSize, argv[2]);
+    if (success)
+    {
+        printf("Rendered %zu events as %zu rows to %s.\n", eventCount, rowCount, argv[2]);
+    }
+
+    free(occupancy);
+    free(image);
+    free(events);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+IndexedEvent *readEvents(FILE *file, size_t *eventCount)
+{
+    size_t capacity = 1024;
+    IndexedEvent *events = malloc(capacity * sizeof *events);
+    *eventCount = 0;
+
+    Event event;
+    while (events != NULL && fread(&event, sizeof event, 1, file) == 1)
+    {
+        if (*eventCount == capacity)
+        {
+            capacity *= 2;
+            IndexedEvent *const newEvents = realloc(events, capacity * sizeof *events);
+            if (newEvents == NULL)
+            {
+                free(events);
+                return NULL;
+            }
+            events = newEvents;
+        }
+
+        events[*eventCount] = (IndexedEvent) { .event = event, .index = *eventCount };
+        ++*eventCount;
+    }
+
+    return events;
+}
+
+int compareEvents(void const *left, void const *right)
+{
+    IndexedEvent const *const l = left;
+    IndexedEvent const *const r = right;
+
+    if (l->event.timestamp != r->event.timestamp)
+    {
+        return l->event.timestamp < r->event.timestamp ? -1 : 1;
+    }
+    return l->index < r->index ? -1 : l->index > r->index;
+}
+
+void applyEvent(uint8_t occupancy[], size_t heapSize, Event event)
+{
+    // Ignore events that don't fit in the heap rather than writing out of bounds
+    if (event.size == 0 || event.offset >= heapSize || event.size > heapSize - event.offset)
+    {
+        return;
+    }
+
+    bool const isAlloc = event.op == EVENT_OP_ALLOC;
+
+    occupancy[event.offset] = isAlloc ? BYTE_CHUNK_START : BYTE_FREE;
+    for (size_t i = 1; i < event.size; ++i)
+    {
+        occupancy[event.offset + i] = isAlloc ? BYTE_ALLOCATED : BYTE_FREE;
+    }
+}
+
+// Same colors as heapDumpChunksBitmap
+void drawRow(uint8_t *row, uint8_t const occupancy[], size_t heapSize)
+{
+    for (size_t i = 0; i < heapSize; ++i)
+    {
+        uint8_t *const px = row + i * BYTES_PER_PIXEL;
+        switch (occupancy[i])
+        {
+        case BYTE_CHUNK_START:
+            px[I_R] = 128;
+            px[I_G] = 0;
+            px[I_B] = 0;
+            break;
+        case BYTE_ALLOCATED:
+            px[I_R] = 255;
+            px[I_G] = 0;
+            px[I_B] = 0;
+            break;
+        default:
+            px[I_R] = 0;
+            px[I_G] = 255;
+            px[I_B] = 0;
+            break;
+        }
+    }
+}
@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "benchmark.h"
+#include "macros.h"
+#include "myHeap.h"
+
+// Maximum number of simultaneous allocations in the workload.
+// Kept below the heap's chunk limit so that failures come from fragmentation.
+#define MAX_LIVE_ALLOCATIONS 24
+
+// Number of times the workload is replayed to measure throughput.
+#define TIMED_RUNS 16
+
+typedef struct
+{
+    // Slot of the allocation in the live allocations array
+    uint8_t slot;
+    bool isAlloc;
+    uint8_t size;
+} Operation;
+
+typedef struct
+{
+    double operationsPerSecond;
+    size_t failedAllocations;
+    double averageFragmentation;
+    double finalFragmentation;
+} BenchmarkResult;
+
+Operation *generateWorkload(size_t operationCount);
+BenchmarkResult runWorkload(FitPolicy policy, Operation const workload[], size_t operationCount);
+size_t replay(Operation const workload[], size_t operationCount, double *fragmentationSum);
+double fragmentation(void);
+uint32_t xorshift32(uint32_t *state);
+
+void benchmarkFitPolicies(size_t operationCount)
+{
+    // Replays start by resetting the heap, which must not throw away live allocations or the heap file
+    if (heapIsFileBacked())
+    {
+        printf("The benchmark can't run on the heap file. Close it first.\n");
+        return;
+    }
+    if (heapGetStats().chunkCount != 0)
+    {
+        printf("The benchmark needs an empty heap.\n");
+        return;
+    }
+
+    Operation *const workload = generateWorkload(operationCount);
+    if (workload == NULL)
+    {
+        printf("Could not allocate a workload of %zu operations.\n", operationCount);
+        return;
+    }
+
+    FitPolicy const previousPolicy = heapGetFitPolicy();
+    bool const previousErrorReporting = heapGetErrorReporting();
+    bool const previousEventRecording = heapGetEventRecording();
+    heapSetErrorReporting(false);
+    // Keep the replays out of the allocation event log
+    heapSetEventRecording(false);
+
+    printf("Workload: %zu operations, replayed %d times\n\n| %-10s | %-16s | %-16s | %-16s | %-16s |\n",
+           operationCount, TIMED_RUNS, "Policy", "Operations/s", "Failed allocs", "Avg. frag.", "Final frag.");
+
+    for (FitPolicy policy = 0; policy < FIT_POLICY_COUNT; ++policy)
+    {
+        BenchmarkResult const result = runWorkload(policy, workload, operationCount);
+        printf("| %-10s | %-16.0f | %-16zu | %-16.3f | %-16.3f |\n",
+               fitPolicyName(policy), result.operationsPerSecond, result.failedAllocations,
+               result.averageFragmentation, result.finalFragmentation);
+    }
+
+    printf("\nFragmentation is 1 - largest free block / free bytes (0 = all free bytes are contiguous).\n");
+
+    heapSetErrorReporting(previousErrorReporting);
+    heapSetEventRecording(previousEventRecording);
+    heapSetFitPolicy(previousPolicy);
+    free(workload);
+}
+
+// Generates a random but reproducible sequence of allocations and frees, so every policy gets the same workload.
+Operation *generateWorkload(size_t operationCount)
+{
+    Operation *const workload = calloc(operationCount, sizeof *workload);
+    if (workload == NULL)
+    {
+        return NULL;
+    }
+
+    bool isLive[MAX_LIVE_ALLOCATIONS] = { 0 };
+    size_t liveCount = 0;
+    uint32_t state = 0xC0FFEE;
+
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        // Alloc with 55% chance, so the heap fills up then hovers around its capacity
+        bool const isAlloc = liveCount == 0
+            || (liveCount < MAX_LIVE_ALLOCATIONS && xorshift32(&state) % 100 < 55);
+
+        // Pick a random slot that is free (alloc) or live (free)
+        uint8_t slot = (uint8_t)(xorshift32(&state) % MAX_LIVE_ALLOCATIONS);
+        while (isLive[slot] == isAlloc)
+        {
+            slot = (uint8_t)((slot + 1) % MAX_LIVE_ALLOCATIONS);
+        }
+
+        isLive[slot] = isAlloc;
+        if (isAlloc)
+        {
+            ++liveCount;
+        }
+        else
+        {
+            --liveCount;
+        }
+
+        // Mostly small blocks, with some larger ones
+        uint32_t const sizeClass = xorshift32(&state) % 4;
+        workload[i] = (Operation) {
+            .slot = slot,
+            .isAlloc = isAlloc,
+            .size = (uint8_t)(sizeClass == 0 ? 16 + xorshift32(&state) % 33 : 1 + xorshift32(&state) % 8),
+        };
+    }
+
+    return workload;
+}
+
+BenchmarkResult runWorkload(FitPolicy policy, Operation const workload[], size_t operationCount)
+{
+    heapSetFitPolicy(policy);
+
+    BenchmarkResult result = { 0 };
+
+    // Timed runs, without measuring fragmentation
+    clock_t const startTime = clock();
+    for (int run = 0; run < TIMED_RUNS; ++run)
+    {
+        replay(workload, operationCount, NULL);
+    }
+    double const elapsed = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    result.operationsPerSecond = elapsed > 0 ? (double)operationCount * TIMED_RUNS / elapsed : 0;
+
+    // Instrumented run
+    double fragmentationSum = 0;
+    result.failedAllocations = replay(workload, operationCount, &fragmentationSum);
+    result.averageFragmentation = operationCount > 0 ? fragmentationSum / (double)operationCount : 0;
+    result.finalFragmentation = fragmentation();
+
+    heapReset();
+    return result;
+}
+
+// Replays a workload on an empty heap. Returns the number of failed allocations.
+// If fragmentationSum is not NULL, the fragmentation after each operation is added to it.
+size_t replay(Operation const workload[], size_t operationCount, double *fragmentationSum)
+{
+    void *live[MAX_LIVE_ALLOCATIONS] = { 0 };
+    size_t failedAllocations = 0;
+
+    heapReset();
+
+    foreach(Operation const, operation, workload, operationCount)
+    {
+        if (operation->isAlloc)
+        {
+            live[operation->slot] = myAlloc(operation->size);
+            failedAllocations += live[operation->slot] == NULL;
+        }
+        else
+        {
+            // Freeing a failed allocation is a no-op
+            myFree(live[operation->slot]);
+            live[operation->slot] = NULL;
+        }
+
+        if (fragmentationSum != NULL)
+        {
+            *fragmentationSum += fragmentation();
+        }
+    }
+
+    return failedAllocations;
+}
+
+double fragmentation(void)
+{
+    HeapStats const stats = heapGetStats();
+    return stats.freeBytes == 0 ? 0 : 1 - (double)stats.largestFreeBlock / (double)stats.freeBytes;
+}
+
+uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
@@ -0,0 +1,8 @@
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+
+#include <stdlib.h>
+
+void benchmarkFitPolicies(size_t operationCount);
+
+#endif // BENCHMARK_H_INCLUDED
@@ -1,4 +1,3 @@
-#include <assert.h>
 #include <stdio.h>
 
 #include "bitmapFactory.h"
@@ -10,7 +9,7 @@
 uint8_t *createBitmapFileHeader(unsigned height, unsigned stride);
 uint8_t *createBitmapInfoHeader(uint32_t height, uint32_t width);
 
-void generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width, char const *imageFileName)
+bool generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width, char const *imageFileName)
 {
     unsigned widthInBytes = width * BYTES_PER_PIXEL;
     unsigned paddingSize = (4 - (widthInBytes) % 4) % 4;
@@ -18,7 +17,11 @@ void generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width,
     uint8_t padding[3] = { 0, 0, 0 };
 
     FILE *imageFile = NULL;
-    assert(fopen_s(&imageFile, imageFileName, "wb") == 0);
+    if (fopen_s(&imageFile, imageFileName, "wb") != 0)
+    {
+        fprintf(stderr, "Could not create %s.\n", imageFileName);
+        return false;
+    }
 
     uint8_t *fileHeader = createBitmapFileHeader(height, widthInBytes + paddingSize);
     fwrite(fileHeader, 1, FILE_HEADER_SIZE, imageFile);
@@ -33,6 +36,7 @@ void generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width,
     }
 
     fclose(imageFile);
+    return true;
 }
 
 uint8_t *createBitmapFileHeader(unsigned height, unsigned stride)
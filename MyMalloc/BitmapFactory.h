@@ -1,6 +1,7 @@
 #ifndef BITMAPFACTORY_H_INCLUDED
 #define BITMAPFACTORY_H_INCLUDED
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define BYTES_PER_PIXEL 3 // red, green, & blue
@@ -12,6 +13,7 @@ enum
     I_B = 0,
 };
 
-void generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width, char const *imageFileName);
+// Returns false if the file could not be created.
+bool generateBitmapImage(uint8_t const *image, uint32_t height, uint32_t width, char const *imageFileName);
 
 #endif // BITMAPFACTORY_H_INCLUDED
@@ -0,0 +1,147 @@
+#include <string.h>
+
+#include "eventLog.h"
+
+// Defined even without HEAP_EVENT_LOG: the file format doesn't depend on it, and it keeps this file from being empty.
+void eventLogWriteHeader(FILE *file, size_t heapSize)
+{
+    EventLogHeader header = {
+        .version = EVENT_LOG_VERSION,
+        .heapSize = (uint32_t)heapSize,
+        .eventSize = sizeof(Event),
+    };
+    memcpy(header.magic, EVENT_LOG_MAGIC, sizeof header.magic);
+
+    fwrite(&header, sizeof header, 1, file);
+}
+
+#if HEAP_EVENT_LOG
+
+#include <stdatomic.h>
+#include <time.h>
+
+// Number of events a thread can record before its ring is drained. Must be a power of 2.
+#define RING_CAPACITY 4096
+
+// Single-producer single-consumer ring buffer.
+// The owning thread advances head, the reader advances tail. Neither ever waits for the other.
+typedef struct Ring
+{
+    Event events[RING_CAPACITY];
+    atomic_size_t head;
+    atomic_size_t tail;
+    // Number of events lost because the ring was full
+    atomic_size_t droppedCount;
+    struct Ring *next;
+} Ring;
+
+Ring *getThreadRing(void);
+uint64_t getTimestamp(void);
+
+// List of the rings of all threads that recorded an event.
+// Rings are never freed, so events recorded by a thread can still be drained after it exits.
+static _Atomic(Ring *) gs_rings = NULL;
+
+// Ring of the calling thread.
+static _Thread_local Ring *gs_threadRing = NULL;
+
+void eventLogRecord(EventOp op, size_t offset, size_t size)
+{
+    Ring *const ring = getThreadRing();
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    size_t const head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t const tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    // Drop the event rather than slowing down the allocator
+    if (head - tail == RING_CAPACITY)
+    {
+        atomic_fetch_add_explicit(&ring->droppedCount, 1, memory_order_relaxed);
+        return;
+    }
+
+    ring->events[head % RING_CAPACITY] = (Event) {
+        .timestamp = getTimestamp(),
+        .offset = (uint32_t)offset,
+        .size = (uint16_t)size,
+        .op = (uint8_t)op,
+    };
+
+    // Publish the event to the reader
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// Appends the pending events of every thread to file. Returns the number of events written.
+// Can be called from any thread, but only one at a time.
+size_t eventLogDrain(FILE *file)
+{
+    size_t eventCount = 0;
+
+    for (Ring *ring = atomic_load_explicit(&gs_rings, memory_order_acquire); ring != NULL; ring = ring->next)
+    {
+        size_t const tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t const head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        for (size_t i = tail; i != head; ++i)
+        {
+            fwrite(&ring->events[i % RING_CAPACITY], sizeof(Event), 1, file);
+        }
+
+        // Hand the slots back to the owning thread
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+        eventCount += head - tail;
+    }
+
+    return eventCount;
+}
+
+size_t eventLogDroppedCount(void)
+{
+    size_t droppedCount = 0;
+
+    for (Ring *ring = atomic_load_explicit(&gs_rings, memory_order_acquire); ring != NULL; ring = ring->next)
+    {
+        droppedCount += atomic_load_explicit(&ring->droppedCount, memory_order_relaxed);
+    }
+
+    return droppedCount;
+}
+
+Ring *getThreadRing(void)
+{
+    if (gs_threadRing == NULL)
+    {
+        Ring *const ring = malloc(sizeof *ring);
+        if (ring == NULL)
+        {
+            return NULL;
+        }
+
+        atomic_init(&ring->head, 0);
+        atomic_init(&ring->tail, 0);
+        atomic_init(&ring->droppedCount, 0);
+
+        // Lock-free push at the front of the list
+        ring->next = atomic_load_explicit(&gs_rings, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&gs_rings, &ring->next, ring,
+                                                      memory_order_release, memory_order_relaxed))
+        {
+        }
+
+        gs_threadRing = ring;
+    }
+
+    return gs_threadRing;
+}
+
+uint64_t getTimestamp(void)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef EVENTLOG_H_INCLUDED
+#define EVENTLOG_H_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Allocation event log.
+// When non-zero, myAlloc and myFree record an event in a ring buffer owned by the calling thread,
+// which eventLogDrain copies to a file. Requires C11 atomics (/experimental:c11atomics on MSVC).
+#ifndef HEAP_EVENT_LOG
+#define HEAP_EVENT_LOG 0
+#endif
+
+#define EVENT_LOG_MAGIC "MHEV"
+#define EVENT_LOG_VERSION 1
+
+typedef enum
+{
+    EVENT_OP_ALLOC = 1,
+    EVENT_OP_FREE = 2,
+} EventOp;
+
+/// <summary>
+/// Header of an event log file. It is followed by eventSize-byte Event records, in native byte order.
+/// Records are grouped by thread: sort them by timestamp to get a timeline.
+/// </summary>
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t heapSize;
+    uint32_t eventSize;
+} EventLogHeader;
+
+typedef struct
+{
+    /// <summary>Nanoseconds since the epoch.</summary>
+    uint64_t timestamp;
+    /// <summary>Offset of the chunk from the start of the heap.</summary>
+    uint32_t offset;
+    /// <summary>Size of the chunk in bytes.</summary>
+    uint16_t size;
+    /// <summary>An EventOp.</summary>
+    uint8_t op;
+    uint8_t reserved;
+} Event;
+
+void eventLogRecord(EventOp op, size_t offset, size_t size);
+void eventLogWriteHeader(FILE *file, size_t heapSize);
+size_t eventLogDrain(FILE *file);
+size_t eventLogDroppedCount(void);
+
+#endif // EVENTLOG_H_INCLUDED
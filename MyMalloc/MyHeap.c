@@ -1,83 +1,216 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <stdbool.h>
 
 #include "myHeap.h"
 #include "bitmapFactory.h"
+#include "eventLog.h"
 #include "macros.h"
+#include "segment.h"
 
 #define DUMP_BMP_HEIGHT 8
 
 #define HEAP_SIZE 256
 #define CHUNKS_LENGTH (HEAP_SIZE / sizeof(void*))
 
+// The page map and events store chunk sizes on 16 bits
+static_assert(HEAP_SIZE <= UINT16_MAX, "HEAP_SIZE too large for the page map and the event log");
+
 // Pointer to the first byte of the heap.
-#define HEAP_START_PTR ((intptr_t)gs_pool)
+#define HEAP_START_PTR ((intptr_t)gs_heap->pool)
 
 // Alignement strategy.
 // myAlloc will align allocations on the nearest multiple of the value evaluated.
 // size represents the requested size in bytes.
+// Must be a power of 2. myAlignedAlloc never aligns on less.
 #define ALIGN 1
 
-// Possible optimizations:
-// - Keep gs_chunks sorted
+// Page map granularity.
+// Chunks start on ALIGN boundaries, so at most one chunk starts in each page.
+#define PAGE_SIZE ALIGN
+#define PAGE_COUNT (ROUND_UP(HEAP_SIZE, PAGE_SIZE) / PAGE_SIZE)
+
+// Huge page backing.
+// When non-zero, the pool and its metadata are placed in a segment aligned on HUGE_PAGE_SIZE,
+// obtained from the OS with huge pages requested (see segment.c). Otherwise, they live in static storage.
+#ifndef HEAP_HUGE_PAGES
+#define HEAP_HUGE_PAGES 0
+#endif
+
+// Heap file format, see heapOpenFile.
+#define HEAP_FILE_MAGIC "MYHEAP"
+#define HEAP_FILE_VERSION 2
+
+// Metadata stores offsets from the start of the pool rather than addresses,
+// so that a heap stays valid wherever it is mapped.
 
 typedef struct
 {
-    intptr_t start;
+    size_t start;
     size_t size;
 } Chunk;
 
-bool rangesOverlap(intptr_t x1, intptr_t x2, intptr_t y1, intptr_t y2);
-bool isAreaAllocated(intptr_t start, size_t size);
+// A free area between two chunks.
+typedef struct
+{
+    size_t start;
+    // Exclusive
+    size_t end;
+} Gap;
+
+// The pool and its metadata, kept together so they can share the same backing memory.
+typedef struct
+{
+    // Identifies heap files. Left zeroed in memory.
+    char magic[sizeof HEAP_FILE_MAGIC];
+    uint32_t version;
+    // Size of this structure when the heap file was created. Heaps built with a different layout are rejected.
+    uint32_t layoutSize;
+
+    // Offset of the root allocation, see heapSetRoot.
+    size_t root;
+    bool hasRoot;
+
+    FitPolicy fitPolicy;
+
+    // Offset of the end of the last allocation. Next-fit resumes its search from there.
+    size_t rover;
+
+    size_t chunkCount;
+
+    // Array of allocated memory chunks, sorted by start address.
+    // It's length represents the maximum number of simulatenous allocations.
+    Chunk chunks[CHUNKS_LENGTH];
+
+    // Page map: size of the chunk starting in each page of the pool, or 0 if none does.
+    // Single-level, since the pool is too small for a deeper radix tree to pay off.
+    // Sizes never exceed HEAP_SIZE, so 16 bits are enough and keep the map small.
+    uint16_t pageMap[PAGE_COUNT];
+
+    // Array of bytes representing the heap
+    uint8_t pool[HEAP_SIZE];
+} Heap;
+
+Heap *getHeap(void);
+bool isHeapConsistent(Heap const *heap);
+size_t getHugePageBytes(void);
+bool firstFit(size_t size, size_t alignment, size_t *index, size_t *start);
+bool nextFit(size_t size, size_t alignment, size_t *index, size_t *start);
+bool bestFit(size_t size, size_t alignment, size_t *index, size_t *start);
+Gap getGapBefore(size_t index);
+bool fitInGap(Gap gap, size_t size, size_t alignment, size_t *start);
+uint16_t *findPageMapEntry(void const *ptr);
+size_t findChunkIndex(size_t start);
+size_t findFirstChunkFrom(size_t start);
+void insertChunkAt(size_t index, Chunk chunk);
 void removeChunkAt(size_t index);
 
-// Array of bytes representing the heap
-static uint8_t gs_pool[HEAP_SIZE];
+// Whether allocation failures are reported on stderr.
+static bool gs_reportErrors = true;
 
-static size_t gs_chunkCount = 0;
+// Whether allocations and frees are recorded in the event log, when it is compiled in.
+static bool gs_recordEvents = true;
 
-// Array of allocated memory chunks.
-// It's length represents the maximum number of simulatenous allocations.
-static Chunk gs_chunks[CHUNKS_LENGTH];
+// Backing memory of the in-memory heap when huge pages are disabled or unavailable.
+static Heap gs_staticHeap;
+
+// The in-memory heap. Initialized on first use by getHeap.
+static Heap *gs_memoryHeap = NULL;
+
+// The heap in use: either the in-memory heap or the heap file opened by heapOpenFile.
+static Heap *gs_heap = NULL;
+
+// Huge page segment backing the in-memory heap, if any.
+static Segment gs_hugePageSegment = { 0 };
+
+// Mapping of the heap file, if any.
+static Segment gs_fileSegment = { 0 };
 
 void *myAlloc(size_t size)
 {
+    return myAlignedAlloc(ALIGN, size);
+}
+
+void *myAlignedAlloc(size_t alignment, size_t size)
+{
+    Heap *const heap = getHeap();
+
     if (size == 0)
     {
         // malloc(0) is unspecified behavior
         // We can either return an unique pointer or NULL.
         return NULL;
     }
-    if (gs_chunkCount == ARRAYLENGTH(gs_chunks))
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        // Like aligned_alloc, only powers of 2 are supported
+        if (gs_reportErrors)
+        {
+            fprintf(stderr, "Allocation failed: alignment (%zu) is not a power of 2.\n", alignment);
+        }
+        return NULL;
+    }
+    if (size > HEAP_SIZE || alignment > HEAP_SIZE)
+    {
+        // Can never fit, and rejecting it here keeps the offset arithmetic below from overflowing
+        if (gs_reportErrors)
+        {
+            fprintf(stderr, "Allocation failed: heap too small.\n");
+        }
+        return NULL;
+    }
+    if (heap->chunkCount == ARRAYLENGTH(heap->chunks))
     {
-        fprintf(stderr, "Allocation failed: maximum number of allocations (%zu) reached.\n", ARRAYLENGTH(gs_chunks));
+        if (gs_reportErrors)
+        {
+            fprintf(stderr, "Allocation failed: maximum number of allocations (%zu) reached.\n", ARRAYLENGTH(heap->chunks));
+        }
         return NULL;
     }
 
-    // nearest multiple of ALIGN greater than HEAP_START_PTR
-    intptr_t const alignedStart = HEAP_START_PTR + HEAP_START_PTR % ALIGN;
+    // Complexity: O(heap->chunkCount) for every policy, since the chunks array is sorted
+    // and the free areas are the gaps between consecutive chunks.
+    size_t index;
+    size_t start;
+    bool found;
+
+    // Both are powers of 2, so the larger one is a multiple of the other
+    alignment = MAX(alignment, ALIGN);
 
-    // Complexity:
-    // -> O(HEAP_SIZE / size * gs_chunkCount)
-    // Best: O(1)
-    // Worst: O(n)
-    for (intptr_t start = alignedStart; start + (intptr_t)size <= HEAP_START_PTR + HEAP_SIZE; start += ALIGN)
+    switch (heap->fitPolicy)
     {
-        if (!isAreaAllocated(start, size))
+    case FIT_POLICY_NEXT: found = nextFit(size, alignment, &index, &start); break;
+    case FIT_POLICY_BEST: found = bestFit(size, alignment, &index, &start); break;
+    default: found = firstFit(size, alignment, &index, &start); break;
+    }
+
+    if (!found)
+    {
+        if (gs_reportErrors)
         {
-            gs_chunks[gs_chunkCount++] = (Chunk) {
-                .start = start,
-                .size = size,
-            };
-            return (void*)start;
+            fprintf(stderr, "Allocation failed: heap too small.\n");
         }
+        return NULL;
     }
 
-    fprintf(stderr, "Allocation failed: heap too small.\n");
-    return NULL;
+    insertChunkAt(index, (Chunk) {
+        .start = start,
+        .size = size,
+    });
+    heap->pageMap[start / PAGE_SIZE] = (uint16_t)size;
+    heap->rover = start + size;
+
+#if HEAP_EVENT_LOG
+    if (gs_recordEvents)
+    {
+        eventLogRecord(EVENT_OP_ALLOC, start, size);
+    }
+#endif
+
+    return heap->pool + start;
 }
 
 void myFree(void const *ptr)
@@ -87,76 +220,567 @@ void myFree(void const *ptr)
         return;
     }
 
-    // Find chunk with correct start pointer
-    bool chunkFound = false;
+    Heap *const heap = getHeap();
+
+    uint16_t *const pageMapEntry = findPageMapEntry(ptr);
+
+    if (pageMapEntry == NULL)
+    {
+        // Freeing an invalid pointer is undefined behavior as per the C standard, so we can do whatever we want here.
+
+        fprintf(stderr, "Tried to free an invalid pointer: %p", ptr);
+        // We could ignore the error, but it's probably unsafe to continue, so fail-fast.
+        abort();
+    }
+
+    size_t const start = (size_t)((uint8_t const *)ptr - heap->pool);
 
-    for (size_t i = 0; i < gs_chunkCount && !chunkFound; ++i)
+#if HEAP_EVENT_LOG
+    if (gs_recordEvents)
     {
-        if (gs_chunks[i].start == (intptr_t)ptr)
+        eventLogRecord(EVENT_OP_FREE, start, *pageMapEntry);
+    }
+#endif
+
+    if (heap->hasRoot && heap->root == start)
+    {
+        heap->hasRoot = false;
+    }
+
+    *pageMapEntry = 0;
+    removeChunkAt(findChunkIndex(start));
+}
+
+void myFreeSized(void const *ptr, size_t size)
+{
+    if (ptr != NULL && myUsableSize(ptr) != size)
+    {
+        fprintf(stderr, "Tried to free %p with the wrong size: %zu", ptr, size);
+        abort();
+    }
+
+    myFree(ptr);
+}
+
+size_t myUsableSize(void const *ptr)
+{
+    if (ptr == NULL)
+    {
+        return 0;
+    }
+
+    getHeap();
+
+    uint16_t const *const pageMapEntry = findPageMapEntry(ptr);
+
+    if (pageMapEntry == NULL)
+    {
+        fprintf(stderr, "Tried to get the usable size of an invalid pointer: %p", ptr);
+        abort();
+    }
+
+    return *pageMapEntry;
+}
+
+void heapSetFitPolicy(FitPolicy policy)
+{
+    assert(IN_ARRAY_BOUNDS(policy, FIT_POLICY_COUNT));
+    getHeap()->fitPolicy = policy;
+}
+
+FitPolicy heapGetFitPolicy(void)
+{
+    return getHeap()->fitPolicy;
+}
+
+char const *fitPolicyName(FitPolicy policy)
+{
+    switch (policy)
+    {
+    case FIT_POLICY_FIRST: return "first-fit";
+    case FIT_POLICY_NEXT: return "next-fit";
+    case FIT_POLICY_BEST: return "best-fit";
+    default: return "unknown";
+    }
+}
+
+void heapSetErrorReporting(bool enabled)
+{
+    gs_reportErrors = enabled;
+}
+
+bool heapGetErrorReporting(void)
+{
+    return gs_reportErrors;
+}
+
+void heapSetEventRecording(bool enabled)
+{
+    gs_recordEvents = enabled;
+}
+
+bool heapGetEventRecording(void)
+{
+    return gs_recordEvents;
+}
+
+void heapReset(void)
+{
+    // The file heap outlives the process: wiping it would lose data the user asked to keep
+    if (heapIsFileBacked())
+    {
+        fprintf(stderr, "Refusing to reset the heap stored in a file. Close it first.\n");
+        return;
+    }
+
+    Heap *const heap = getHeap();
+
+#if HEAP_EVENT_LOG
+    // Keep the event log consistent with the heap
+    if (gs_recordEvents)
+    {
+        foreach(Chunk const, chunk, heap->chunks, heap->chunkCount)
+        {
+            eventLogRecord(EVENT_OP_FREE, chunk->start, chunk->size);
+        }
+    }
+#endif
+
+    heap->chunkCount = 0;
+    heap->rover = 0;
+    heap->hasRoot = false;
+    memset(heap->pageMap, 0, sizeof heap->pageMap);
+}
+
+size_t heapGetSize(void)
+{
+    return HEAP_SIZE;
+}
+
+HeapStats heapGetStats(void)
+{
+    Heap const *const heap = getHeap();
+
+    HeapStats stats = {
+        .chunkCount = heap->chunkCount,
+        .allocatedBytes = 0,
+        .freeBytes = 0,
+        .largestFreeBlock = 0,
+        .segmentBytes = 0,
+        .hugePageBytes = 0,
+    };
+
+    // The heap file is never backed by the huge page segment
+    if (gs_fileSegment.base == NULL && gs_hugePageSegment.base != NULL)
+    {
+        stats.segmentBytes = gs_hugePageSegment.size;
+        stats.hugePageBytes = getHugePageBytes();
+    }
+
+    foreach(Chunk const, chunk, heap->chunks, heap->chunkCount)
+    {
+        stats.allocatedBytes += chunk->size;
+    }
+
+    for (size_t i = 0; i <= heap->chunkCount; ++i)
+    {
+        Gap const gap = getGapBefore(i);
+        size_t const gapSize = (size_t)(gap.end - gap.start);
+        stats.freeBytes += gapSize;
+        if (gapSize > stats.largestFreeBlock)
         {
-            chunkFound = true;
-            removeChunkAt(i);
+            stats.largestFreeBlock = gapSize;
         }
     }
 
-    if (!chunkFound)
+    return stats;
+}
+
+bool heapOpenFile(char const *filename)
+{
+    heapClose();
+
+    bool isNew;
+    Segment const segment = segmentMapFile(filename, sizeof(Heap), &isNew);
+    if (segment.base == NULL)
     {
-        // Freeing an invalid pointer is undefined behavior as per the C standard, so we can do whatever we want here.
+        fprintf(stderr, "Could not map heap file %s. It may be open in another process.\n", filename);
+        return false;
+    }
 
-        fprintf(stderr, "Tried to free an invalid pointer: %p", ptr);
-        // We could ignore the error, but it's probably unsafe to continue, so fail-fast.
+    Heap *const heap = segment.base;
+
+    if (isNew)
+    {
+        // The file was just created and is zero-filled, like a fresh in-memory heap: only stamp it.
+        memcpy(heap->magic, HEAP_FILE_MAGIC, sizeof heap->magic);
+        heap->version = HEAP_FILE_VERSION;
+        heap->layoutSize = sizeof(Heap);
+    }
+    else if (memcmp(heap->magic, HEAP_FILE_MAGIC, sizeof heap->magic) != 0
+             || heap->version != HEAP_FILE_VERSION
+             || heap->layoutSize != sizeof(Heap))
+    {
+        fprintf(stderr, "%s is not a heap file or was created by an incompatible build.\n", filename);
+        segmentRelease(segment);
+        return false;
+    }
+    else if (!isHeapConsistent(heap))
+    {
+        // The file may have been truncated by a crash or edited: every offset in it would be trusted from now on
+        fprintf(stderr, "%s is corrupted.\n", filename);
+        segmentRelease(segment);
+        return false;
+    }
+
+    gs_fileSegment = segment;
+    gs_heap = heap;
+    return true;
+}
+
+void heapClose(void)
+{
+    if (gs_fileSegment.base != NULL)
+    {
+        segmentRelease(gs_fileSegment);
+        gs_fileSegment = (Segment) { 0 };
+
+        // Back to the in-memory heap
+        gs_heap = NULL;
+    }
+}
+
+bool heapIsFileBacked(void)
+{
+    return gs_fileSegment.base != NULL;
+}
+
+size_t heapPointerToOffset(void const *ptr)
+{
+    Heap const *const heap = getHeap();
+    assert((uint8_t const *)ptr >= heap->pool && (uint8_t const *)ptr < heap->pool + HEAP_SIZE);
+    return (size_t)((uint8_t const *)ptr - heap->pool);
+}
+
+void *heapOffsetToPointer(size_t offset)
+{
+    Heap *const heap = getHeap();
+    assert(offset < HEAP_SIZE);
+    return heap->pool + offset;
+}
+
+void heapSetRoot(void const *ptr)
+{
+    Heap *const heap = getHeap();
+
+    if (ptr == NULL)
+    {
+        heap->hasRoot = false;
+        return;
+    }
+
+    if (findPageMapEntry(ptr) == NULL)
+    {
+        fprintf(stderr, "Tried to set an invalid pointer as root: %p", ptr);
         abort();
     }
+
+    heap->root = (size_t)((uint8_t const *)ptr - heap->pool);
+    heap->hasRoot = true;
+}
+
+void *heapGetRoot(void)
+{
+    Heap *const heap = getHeap();
+    return heap->hasRoot ? heap->pool + heap->root : NULL;
+}
+
+Heap *getHeap(void)
+{
+    if (gs_heap == NULL)
+    {
+        if (gs_memoryHeap == NULL)
+        {
+#if HEAP_HUGE_PAGES
+            gs_hugePageSegment = segmentAllocateHuge(sizeof(Heap));
+            if (gs_hugePageSegment.base == NULL)
+            {
+                fprintf(stderr, "Huge page segment allocation failed, falling back to static storage.\n");
+            }
+#endif
+            // Fresh OS memory is zeroed, just like static storage: no further initialization needed.
+            gs_memoryHeap = gs_hugePageSegment.base == NULL ? &gs_staticHeap : gs_hugePageSegment.base;
+        }
+        gs_heap = gs_memoryHeap;
+    }
+    return gs_heap;
 }
 
-// Checks if at least one chunk occupies at least one byte of the specified memory area.
-bool isAreaAllocated(intptr_t start, size_t size)
+// Checks that the metadata of a heap can be trusted: chunks sorted, disjoint and inside the pool,
+// page map matching the chunks, and every other field in range.
+// Complexity: O(PAGE_COUNT)
+bool isHeapConsistent(Heap const *heap)
 {
-    foreach(Chunk const, chunk, gs_chunks, gs_chunkCount)
+    if (heap->chunkCount > CHUNKS_LENGTH
+        || heap->rover > HEAP_SIZE
+        || (unsigned)heap->fitPolicy >= FIT_POLICY_COUNT)
     {
-        if (rangesOverlap(chunk->start, chunk->start + chunk->size - 1,
-                          start, start + size - 1))
+        return false;
+    }
+
+    size_t previousEnd = 0;
+    foreach(Chunk const, chunk, heap->chunks, heap->chunkCount)
+    {
+        if (chunk->start >= HEAP_SIZE
+            || chunk->size == 0
+            || chunk->size > HEAP_SIZE - chunk->start
+            || chunk->start < previousEnd
+            || chunk->start % ALIGN != 0
+            || heap->pageMap[chunk->start / PAGE_SIZE] != chunk->size)
         {
+            return false;
+        }
+        previousEnd = chunk->start + chunk->size;
+    }
+
+    // Chunks start in distinct pages, so the map must have exactly one entry per chunk
+    size_t entryCount = 0;
+    for (size_t i = 0; i < PAGE_COUNT; ++i)
+    {
+        entryCount += heap->pageMap[i] != 0;
+    }
+    if (entryCount != heap->chunkCount)
+    {
+        return false;
+    }
+
+    // The root must be the start of a chunk
+    return !heap->hasRoot
+        || (heap->root < HEAP_SIZE && heap->root % PAGE_SIZE == 0 && heap->pageMap[heap->root / PAGE_SIZE] != 0);
+}
+
+// Gets the number of bytes of the huge page segment backed by huge pages.
+size_t getHugePageBytes(void)
+{
+    return segmentHugePageBytes(gs_hugePageSegment);
+}
+
+// Fit policies.
+// Each one looks for a gap that can hold size bytes.
+// On success, sets index to the index of the gap, which is also the index of the new chunk in the chunks array,
+// and start to the offset of the allocation.
+
+// Takes the first gap that fits, starting from the beginning of the heap.
+bool firstFit(size_t size, size_t alignment, size_t *index, size_t *start)
+{
+    for (size_t i = 0; i <= gs_heap->chunkCount; ++i)
+    {
+        if (fitInGap(getGapBefore(i), size, alignment, start))
+        {
+            *index = i;
             return true;
         }
     }
     return false;
 }
 
-void removeChunkAt(size_t index)
+// Takes the first gap that fits, starting from where the last allocation ended and wrapping around.
+// This avoids rescanning the small blocks that first-fit piles up at the beginning of the heap.
+bool nextFit(size_t size, size_t alignment, size_t *index, size_t *start)
+{
+    size_t const rover = gs_heap->rover;
+
+    // The gap containing the rover is the one before the first chunk past it
+    size_t const roverIndex = findFirstChunkFrom(rover + 1);
+
+    for (size_t i = roverIndex; i <= gs_heap->chunkCount; ++i)
+    {
+        Gap gap = getGapBefore(i);
+        if (gap.start < rover)
+        {
+            gap.start = rover;
+        }
+        if (fitInGap(gap, size, alignment, start))
+        {
+            *index = i;
+            return true;
+        }
+    }
+
+    // Wrap around. The rover's gap is scanned again for the part that precedes the rover.
+    for (size_t i = 0; i <= roverIndex; ++i)
+    {
+        if (fitInGap(getGapBefore(i), size, alignment, start))
+        {
+            *index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Takes the smallest gap that fits. Ties are broken by address, lowest first.
+bool bestFit(size_t size, size_t alignment, size_t *index, size_t *start)
+{
+    size_t bestSlack = SIZE_MAX;
+
+    for (size_t i = 0; i <= gs_heap->chunkCount && bestSlack != 0; ++i)
+    {
+        Gap const gap = getGapBefore(i);
+        size_t candidate;
+        if (!fitInGap(gap, size, alignment, &candidate))
+        {
+            continue;
+        }
+
+        // fitInGap guarantees candidate + size <= gap.end
+        size_t const slack = (gap.end - candidate) - size;
+        if (slack < bestSlack)
+        {
+            bestSlack = slack;
+            *index = i;
+            *start = candidate;
+        }
+    }
+
+    return bestSlack != SIZE_MAX;
+}
+
+// Gets the gap preceding the chunk at index, or the gap following the last chunk if index is the chunk count.
+Gap getGapBefore(size_t index)
+{
+    Chunk const *const chunks = gs_heap->chunks;
+    return (Gap) {
+        .start = index == 0 ? 0 : chunks[index - 1].start + chunks[index - 1].size,
+        .end = index == gs_heap->chunkCount ? HEAP_SIZE : chunks[index].start,
+    };
+}
+
+// Checks whether an allocation of size bytes fits in a gap. If so, sets start to its aligned offset.
+bool fitInGap(Gap gap, size_t size, size_t alignment, size_t *start)
+{
+    // Align the address, not the offset. Unsigned arithmetic, and comparisons written so that nothing wraps around.
+    uintptr_t const address = (uintptr_t)gs_heap->pool + gap.start;
+    size_t const padding = (size_t)((alignment - address % alignment) % alignment);
+    size_t const gapSize = gap.end - gap.start;
+
+    if (padding > gapSize || size > gapSize - padding)
+    {
+        return false;
+    }
+
+    *start = gap.start + padding;
+    return true;
+}
+
+// Gets the page map entry of the chunk starting at ptr, or NULL if ptr is not the start of a chunk.
+// Complexity: O(1)
+uint16_t *findPageMapEntry(void const *ptr)
+{
+    intptr_t const address = (intptr_t)ptr;
+
+    if (address < HEAP_START_PTR || address >= HEAP_START_PTR + HEAP_SIZE || address % ALIGN != 0)
+    {
+        return NULL;
+    }
+
+    uint16_t *const entry = &gs_heap->pageMap[(size_t)(address - HEAP_START_PTR) / PAGE_SIZE];
+    return *entry == 0 ? NULL : entry;
+}
+
+// Gets the index of the chunk with the specified start address, which must exist.
+// Complexity: O(log(chunkCount))
+size_t findChunkIndex(size_t start)
+{
+    size_t const index = findFirstChunkFrom(start);
+    assert(index < gs_heap->chunkCount && gs_heap->chunks[index].start == start);
+    return index;
+}
+
+// Gets the index of the first chunk starting at or after start, or the chunk count if there is none.
+// Complexity: O(log(chunkCount))
+size_t findFirstChunkFrom(size_t start)
+{
+    size_t low = 0;
+    size_t high = gs_heap->chunkCount;
+
+    while (low < high)
+    {
+        size_t const middle = low + (high - low) / 2;
+        if (gs_heap->chunks[middle].start < start)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void insertChunkAt(size_t index, Chunk chunk)
 {
-    for (size_t i = index; i < gs_chunkCount; ++i)
+    for (size_t i = gs_heap->chunkCount; i > index; --i)
     {
-        gs_chunks[i] = gs_chunks[i + 1];
+        gs_heap->chunks[i] = gs_heap->chunks[i - 1];
     }
-    --gs_chunkCount;
+    gs_heap->chunks[index] = chunk;
+    ++gs_heap->chunkCount;
 }
 
-bool rangesOverlap(intptr_t x1, intptr_t x2, intptr_t y1, intptr_t y2)
+void removeChunkAt(size_t index)
 {
-    assert(x1 <= x2 && y1 <= y2);
-    return x1 <= y2 && y1 <= x2;
+    for (size_t i = index; i < gs_heap->chunkCount - 1; ++i)
+    {
+        gs_heap->chunks[i] = gs_heap->chunks[i + 1];
+    }
+    --gs_heap->chunkCount;
 }
 
 
 void heapDumpChunksConsole(void)
 {
+    Heap const *const heap = getHeap();
+
     // Print chunk list
     printf("Chunks (%zu/%zu):\n\n| %-2s | %-16s | %-16s |\n",
-           gs_chunkCount, CHUNKS_LENGTH, "#", "Start offset", "Size");
+           heap->chunkCount, CHUNKS_LENGTH, "#", "Start offset", "Size");
     size_t totalSize = 0;
-    for (size_t i = 0; i < gs_chunkCount; ++i)
+    for (size_t i = 0; i < heap->chunkCount; ++i)
     {
-        Chunk const chunk = gs_chunks[i];
-        printf("| %-2zu | %-16Id | %-16zu |\n", i, chunk.start - HEAP_START_PTR, chunk.size);
+        Chunk const chunk = heap->chunks[i];
+        printf("| %-2zu | %-16zu | %-16zu |\n", i, chunk.start, chunk.size);
         totalSize += chunk.size;
     }
+    HeapStats const stats = heapGetStats();
     printf("\n%zu/%zu bytes allocated\n", totalSize, (size_t)HEAP_SIZE);
+    printf("Largest free block: %zu bytes\n", stats.largestFreeBlock);
+    printf("Fit policy: %s\n", fitPolicyName(heap->fitPolicy));
+
+    if (gs_fileSegment.base != NULL)
+    {
+        printf("Backing: heap file\n");
+    }
+    else if (stats.segmentBytes == 0)
+    {
+        printf("Huge pages: not used\n");
+    }
+    else
+    {
+        printf("Huge pages: %zu/%zu bytes of the heap segment\n", stats.hugePageBytes, stats.segmentBytes);
+    }
 }
 
-void heapDumpChunksBitmap(char const *filename)
+bool heapDumpChunksBitmap(char const *filename)
 {
-    static uint8_t image[DUMP_BMP_HEIGHT][HEAP_SIZE][BYTES_PER_PIXEL] = { 0 };
+    Heap const *const heap = getHeap();
+
+    // One extra row for the huge page coverage bar
+    static uint8_t image[DUMP_BMP_HEIGHT + 1][HEAP_SIZE][BYTES_PER_PIXEL] = { 0 };
+    uint32_t height = DUMP_BMP_HEIGHT;
 
     // Draw the whole bar in green
     for (size_t i = 0; i < HEAP_SIZE; ++i)
@@ -171,19 +795,19 @@ void heapDumpChunksBitmap(char const *filename)
     }
 
     // Draw chunks individually
-    foreach(Chunk const, chunk, gs_chunks, gs_chunkCount)
+    foreach(Chunk const, chunk, heap->chunks, heap->chunkCount)
     {
         for (size_t y = 0; y < DUMP_BMP_HEIGHT; ++y)
         {
             // Draw sepearator
-            uint8_t *const pxSep = image[y][chunk->start - HEAP_START_PTR];
+            uint8_t *const pxSep = image[y][chunk->start];
             pxSep[I_R] = 128;
             pxSep[I_G] = 0;
             pxSep[I_B] = 0;
 
             for (size_t i = 1; i < chunk->size; ++i)
             {
-                uint8_t *const pxRepr = image[y][chunk->start - HEAP_START_PTR + i];
+                uint8_t *const pxRepr = image[y][chunk->start + i];
                 pxRepr[I_R] = 255;
                 pxRepr[I_G] = 0;
                 pxRepr[I_B] = 0;
@@ -191,16 +815,33 @@ void heapDumpChunksBitmap(char const *filename)
         }
     }
 
-    generateBitmapImage((uint8_t const *)image, DUMP_BMP_HEIGHT, HEAP_SIZE, filename);
+    // Draw the huge page coverage bar on top: the blue part is the share of the segment backed by huge pages
+    HeapStats const stats = heapGetStats();
+    if (stats.segmentBytes != 0)
+    {
+        size_t const coveredWidth = (size_t)((double)HEAP_SIZE * (double)stats.hugePageBytes / (double)stats.segmentBytes);
+        for (size_t i = 0; i < HEAP_SIZE; ++i)
+        {
+            uint8_t *const px = image[DUMP_BMP_HEIGHT][i];
+            px[I_R] = 0;
+            px[I_G] = 0;
+            px[I_B] = i < coveredWidth ? 255 : 0;
+        }
+        ++height;
+    }
+
+    return generateBitmapImage((uint8_t const *)image, height, HEAP_SIZE, filename);
 }
 
-void heapDumpDataBitmap(char const *filename)
+bool heapDumpDataBitmap(char const *filename)
 {
+    Heap const *const heap = getHeap();
+
     static uint8_t image[DUMP_BMP_HEIGHT][HEAP_SIZE][BYTES_PER_PIXEL] = { 0 };
 
     for (size_t i = 0; i < HEAP_SIZE; ++i)
     {
-        uint8_t const byte = gs_pool[i];
+        uint8_t const byte = heap->pool[i];
 
         for (size_t y = 0; y < DUMP_BMP_HEIGHT; ++y)
         {
@@ -210,5 +851,5 @@ void heapDumpDataBitmap(char const *filename)
         }
     }
 
-    generateBitmapImage((uint8_t const *)image, DUMP_BMP_HEIGHT, HEAP_SIZE, filename);
+    return generateBitmapImage((uint8_t const *)image, DUMP_BMP_HEIGHT, HEAP_SIZE, filename);
 }
\ No newline at end of file
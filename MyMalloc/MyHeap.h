@@ -1,12 +1,65 @@
 #ifndef MYHEAP_H_INCLUDED
 #define MYHEAP_H_INCLUDED
 
+#include <stdbool.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// <summary>Strategy used by myAlloc to choose where an allocation goes.</summary>
+typedef enum
+{
+    /// <summary>First free area that fits, from the start of the heap.</summary>
+    FIT_POLICY_FIRST,
+    /// <summary>First free area that fits, from where the previous allocation ended.</summary>
+    FIT_POLICY_NEXT,
+    /// <summary>Smallest free area that fits, lowest address first.</summary>
+    FIT_POLICY_BEST,
+    FIT_POLICY_COUNT,
+} FitPolicy;
+
+typedef struct
+{
+    size_t chunkCount;
+    size_t allocatedBytes;
+    size_t freeBytes;
+    size_t largestFreeBlock;
+    /// <summary>Size of the huge page segment backing the heap, or 0 if the heap isn't backed by one.</summary>
+    size_t segmentBytes;
+    /// <summary>Number of bytes of the segment actually backed by huge pages.</summary>
+    size_t hugePageBytes;
+} HeapStats;
+
 void *myAlloc(size_t size);
+void *myAlignedAlloc(size_t alignment, size_t size);
 void myFree(void const *ptr);
+void myFreeSized(void const *ptr, size_t size);
+size_t myUsableSize(void const *ptr);
+void heapSetFitPolicy(FitPolicy policy);
+FitPolicy heapGetFitPolicy(void);
+char const *fitPolicyName(FitPolicy policy);
+void heapSetErrorReporting(bool enabled);
+bool heapGetErrorReporting(void);
+void heapSetEventRecording(bool enabled);
+bool heapGetEventRecording(void);
+void heapReset(void);
+size_t heapGetSize(void);
+HeapStats heapGetStats(void);
+bool heapOpenFile(char const *filename);
+void heapClose(void);
+bool heapIsFileBacked(void);
+size_t heapPointerToOffset(void const *ptr);
+void *heapOffsetToPointer(size_t offset);
+void heapSetRoot(void const *ptr);
+void *heapGetRoot(void);
 void heapDumpChunksConsole(void);
-void heapDumpChunksBitmap(char const *filename);
-void heapDumpDataBitmap(char const *filename);
+bool heapDumpChunksBitmap(char const *filename);
+bool heapDumpDataBitmap(char const *filename);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // MYHEAP_H_INCLUDED
@@ -0,0 +1,107 @@
+#ifndef MYHEAPRESOURCE_HPP_INCLUDED
+#define MYHEAPRESOURCE_HPP_INCLUDED
+
+// C++17 adaptors to put standard containers on MyHeap.
+// Both forward the size and alignment of every request, so they use myAlignedAlloc and myFreeSized.
+// There is a single heap (in memory, or the file opened by heapOpenFile), so all instances are interchangeable.
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+#include "myHeap.h"
+
+namespace myHeapDetail
+{
+    // myAlloc returns NULL for 0 bytes, but allocators must return a unique pointer.
+    inline std::size_t requestSize(std::size_t bytes) noexcept
+    {
+        return bytes == 0 ? 1 : bytes;
+    }
+
+    inline void *allocate(std::size_t bytes, std::size_t alignment)
+    {
+        void *const ptr = myAlignedAlloc(alignment, requestSize(bytes));
+        if (ptr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    inline void deallocate(void *ptr, std::size_t bytes) noexcept
+    {
+        myFreeSized(ptr, requestSize(bytes));
+    }
+}
+
+/// <summary>std::pmr::memory_resource backed by MyHeap.</summary>
+class MyHeapResource final : public std::pmr::memory_resource
+{
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return myHeapDetail::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *ptr, std::size_t bytes, std::size_t) override
+    {
+        myHeapDetail::deallocate(ptr, bytes);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return dynamic_cast<MyHeapResource const *>(&other) != nullptr;
+    }
+};
+
+/// <summary>Gets a MyHeapResource, e.g. to pass to std::pmr containers.</summary>
+inline MyHeapResource *myHeapResource() noexcept
+{
+    static MyHeapResource resource;
+    return &resource;
+}
+
+/// <summary>Stateless allocator backed by MyHeap, for containers that take an allocator template argument.</summary>
+template <class T>
+class MyHeapAllocator
+{
+public:
+    using value_type = T;
+
+    MyHeapAllocator() noexcept = default;
+
+    template <class U>
+    MyHeapAllocator(MyHeapAllocator<U> const &) noexcept
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(myHeapDetail::allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *ptr, std::size_t count) noexcept
+    {
+        myHeapDetail::deallocate(ptr, count * sizeof(T));
+    }
+};
+
+template <class T, class U>
+bool operator==(MyHeapAllocator<T> const &, MyHeapAllocator<U> const &) noexcept
+{
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(MyHeapAllocator<T> const &, MyHeapAllocator<U> const &) noexcept
+{
+    return false;
+}
+
+#endif // MYHEAPRESOURCE_HPP_INCLUDED
@@ -0,0 +1,320 @@
+#ifndef _WIN32
+// Exposes MAP_ANONYMOUS and ftruncate in strict C mode. Must come before any system header.
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "segment.h"
+#include "macros.h"
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+bool enableLockMemoryPrivilege(void);
+
+Segment segmentAllocateHuge(size_t size)
+{
+    Segment segment = {
+        .base = NULL,
+        .size = ROUND_UP(size, HUGE_PAGE_SIZE),
+        .isLargePage = false,
+        .isFileMapped = false,
+    };
+
+    // Large pages require the "Lock pages in memory" privilege, which is not enabled by default.
+    SIZE_T const largePageMinimum = GetLargePageMinimum();
+    if (largePageMinimum != 0 && HUGE_PAGE_SIZE % largePageMinimum == 0 && enableLockMemoryPrivilege())
+    {
+        segment.base = VirtualAlloc(NULL, segment.size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        segment.isLargePage = segment.base != NULL;
+    }
+
+    if (segment.base == NULL)
+    {
+        // Windows has no transparent huge pages, so this segment will be backed by regular pages.
+        segment.base = VirtualAlloc(NULL, segment.size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    if (segment.base == NULL)
+    {
+        segment.size = 0;
+    }
+
+    return segment;
+}
+
+// Maps a file of size bytes, creating it if it doesn't exist.
+// An existing file must be exactly size bytes long. isNew is set if the file was empty, in which case it is zero-filled.
+Segment segmentMapFile(char const *filename, size_t size, bool *isNew)
+{
+    Segment segment = {
+        .base = NULL,
+        .size = size,
+        .isLargePage = false,
+        .isFileMapped = true,
+    };
+
+    HANDLE const file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                    OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        segment.size = 0;
+        return segment;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart == 0 || (unsigned long long)fileSize.QuadPart == size))
+    {
+        *isNew = fileSize.QuadPart == 0;
+
+        // Grows an empty file to size bytes
+        HANDLE const mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                                                  (DWORD)((unsigned long long)size >> 32), (DWORD)size, NULL);
+        if (mapping != NULL)
+        {
+            segment.base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            // The view keeps the mapping and the file open
+            CloseHandle(mapping);
+        }
+    }
+
+    CloseHandle(file);
+
+    if (segment.base == NULL)
+    {
+        segment.size = 0;
+    }
+
+    return segment;
+}
+
+void segmentRelease(Segment segment)
+{
+    if (segment.base == NULL)
+    {
+        return;
+    }
+
+    if (segment.isFileMapped)
+    {
+        FlushViewOfFile(segment.base, 0);
+        UnmapViewOfFile(segment.base);
+    }
+    else
+    {
+        VirtualFree(segment.base, 0, MEM_RELEASE);
+    }
+}
+
+size_t segmentHugePageBytes(Segment segment)
+{
+    return segment.isLargePage ? segment.size : 0;
+}
+
+bool enableLockMemoryPrivilege(void)
+{
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+    {
+        return false;
+    }
+
+    TOKEN_PRIVILEGES privileges = { .PrivilegeCount = 1 };
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    // AdjustTokenPrivileges succeeds even when the privilege is not granted to the user, hence the GetLastError check.
+    bool const success = LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+        && AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL)
+        && GetLastError() == ERROR_SUCCESS;
+
+    CloseHandle(token);
+    return success;
+}
+
+#else
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Segment segmentAllocateHuge(size_t size)
+{
+    Segment segment = {
+        .base = NULL,
+        .size = ROUND_UP(size, HUGE_PAGE_SIZE),
+        .isLargePage = false,
+        .isFileMapped = false,
+    };
+
+#if defined(SEGMENT_USE_HUGETLB) && defined(MAP_HUGETLB)
+    // Explicit huge pages from the hugetlbfs pool. Fails unless pages were reserved (vm.nr_hugepages).
+    void *const hugetlb = mmap(NULL, segment.size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (hugetlb != MAP_FAILED)
+    {
+        segment.base = hugetlb;
+        segment.isLargePage = true;
+        return segment;
+    }
+#endif
+
+    // Over-reserve so that a range aligned on HUGE_PAGE_SIZE can be carved out, then trim the excess.
+    size_t const reservedSize = segment.size + HUGE_PAGE_SIZE;
+    uint8_t *const reserved = mmap(NULL, reservedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED)
+    {
+        segment.size = 0;
+        return segment;
+    }
+
+    uint8_t *const aligned = (uint8_t *)ROUND_UP((uintptr_t)reserved, HUGE_PAGE_SIZE);
+    size_t const headSize = (size_t)(aligned - reserved);
+    size_t const tailSize = reservedSize - headSize - segment.size;
+
+    if (headSize > 0)
+    {
+        munmap(reserved, headSize);
+    }
+    if (tailSize > 0)
+    {
+        munmap(aligned + segment.size, tailSize);
+    }
+
+    segment.base = aligned;
+
+#ifdef MADV_HUGEPAGE
+    // Only a hint: the kernel decides whether to promote the segment, see segmentHugePageBytes.
+    madvise(segment.base, segment.size, MADV_HUGEPAGE);
+#endif
+
+    return segment;
+}
+
+// Maps a file of size bytes, creating it if it doesn't exist.
+// An existing file must be exactly size bytes long. isNew is set if the file was empty, in which case it is zero-filled.
+Segment segmentMapFile(char const *filename, size_t size, bool *isNew)
+{
+    Segment segment = {
+        .base = NULL,
+        .size = size,
+        .isLargePage = false,
+        .isFileMapped = true,
+    };
+
+    int const fd = open(filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        segment.size = 0;
+        return segment;
+    }
+
+    // Like the share mode 0 on Windows: a second process must not map the same file
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        close(fd);
+        segment.size = 0;
+        return segment;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && (status.st_size == 0 || (size_t)status.st_size == size))
+    {
+        *isNew = status.st_size == 0;
+
+        // Grows an empty file to size bytes
+        if (!*isNew || ftruncate(fd, (off_t)size) == 0)
+        {
+            void *const base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED)
+            {
+                segment.base = base;
+            }
+        }
+    }
+
+    if (segment.base == NULL)
+    {
+        close(fd);
+        segment.size = 0;
+        return segment;
+    }
+
+    // The lock lasts as long as the descriptor is open
+    segment.fd = fd;
+    return segment;
+}
+
+void segmentRelease(Segment segment)
+{
+    if (segment.base == NULL)
+    {
+        return;
+    }
+
+    if (segment.isFileMapped)
+    {
+        msync(segment.base, segment.size, MS_SYNC);
+        munmap(segment.base, segment.size);
+        // Releases the lock
+        close(segment.fd);
+    }
+    else
+    {
+        munmap(segment.base, segment.size);
+    }
+}
+
+size_t segmentHugePageBytes(Segment segment)
+{
+    if (segment.base == NULL)
+    {
+        return 0;
+    }
+    if (segment.isLargePage)
+    {
+        return segment.size;
+    }
+
+    // Transparent huge pages are promoted behind our back, so ask the kernel how much of the segment they back.
+    FILE *const smaps = fopen("/proc/self/smaps", "r");
+    if (smaps == NULL)
+    {
+        return 0;
+    }
+
+    uintptr_t const segmentStart = (uintptr_t)segment.base;
+    uintptr_t const segmentEnd = segmentStart + segment.size;
+
+    size_t hugePageBytes = 0;
+    bool inSegment = false;
+    char line[256];
+
+    while (fgets(line, sizeof line, smaps) != NULL)
+    {
+        uintptr_t start, end;
+        size_t kiB;
+
+        if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR, &start, &end) == 2)
+        {
+            // Mapping header
+            inSegment = start < segmentEnd && segmentStart < end;
+        }
+        else if (inSegment && sscanf(line, "AnonHugePages: %zu kB", &kiB) == 1)
+        {
+            hugePageBytes += kiB * 1024;
+        }
+    }
+
+    fclose(smaps);
+
+    // The kernel may have merged the segment with a neighbouring mapping.
+    return hugePageBytes < segment.size ? hugePageBytes : segment.size;
+}
+
+#endif
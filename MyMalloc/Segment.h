@@ -0,0 +1,40 @@
+#ifndef SEGMENT_H_INCLUDED
+#define SEGMENT_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/// <summary>Size of a huge page. Segments are sized and aligned on this value so they can be promoted.</summary>
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+/// <summary>A block of memory obtained directly from the operating system.</summary>
+typedef struct
+{
+    void *base;
+    /// <summary>
+    /// Size of the segment in bytes. A multiple of HUGE_PAGE_SIZE, unless the segment is file mapped.
+    /// </summary>
+    size_t size;
+    /// <summary>
+    /// Whether the segment was obtained as explicit large pages (hugetlbfs or MEM_LARGE_PAGES),
+    /// as opposed to transparent huge pages that the kernel may or may not have promoted.
+    /// </summary>
+    bool isLargePage;
+    /// <summary>
+    /// Whether the segment is a shared mapping of a file, in which case size is the size of the file.
+    /// </summary>
+    bool isFileMapped;
+#ifndef _WIN32
+    /// <summary>
+    /// Descriptor of the mapped file, kept open to hold an exclusive lock on it until the segment is released.
+    /// </summary>
+    int fd;
+#endif
+} Segment;
+
+Segment segmentAllocateHuge(size_t size);
+Segment segmentMapFile(char const *filename, size_t size, bool *isNew);
+void segmentRelease(Segment segment);
+size_t segmentHugePageBytes(Segment segment);
+
+#endif // SEGMENT_H_INCLUDED
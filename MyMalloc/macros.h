@@ -15,6 +15,15 @@
     varName != array + count;                      \
     ++varName)
 
+/// <summary>Rounds n up to the nearest multiple of multiple.</summary>
+#define ROUND_UP(n, multiple) (((n) + (multiple) - 1) / (multiple) * (multiple))
+
+/// <summary>Determines the smaller of 2 values. Evaluates its arguments twice.</summary>
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/// <summary>Determines the larger of 2 values. Evaluates its arguments twice.</summary>
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
 /// <summary>Checks if i is a valid index of an array of length length.</summary>
 #define IN_ARRAY_BOUNDS(i, length) (0 <= (i) && (i) < (length))
 
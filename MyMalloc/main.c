@@ -2,12 +2,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "benchmark.h"
 #include "commands.h"
+#include "eventLog.h"
 #include "macros.h"
 #include "myHeap.h"
 
 #define CHUNKS_DUMP_FILENAME "heap_chunks_dump.bmp"
 #define DATA_DUMP_FILENAME "heap_data_dump.bmp"
+#define EVENT_LOG_FILENAME "heap_events.bin"
+#define HEAP_FILENAME "heap.bin"
 typedef struct
 {
     size_t size;
@@ -16,6 +20,7 @@ typedef struct
 
 void printAllocations(Allocation const allocations[], size_t allocationCount);
 void removeAt(Allocation array[], size_t *length, size_t index);
+void drainEventLog(FILE **file);
 
 void *customAlloc(size_t size)
 {
@@ -62,6 +67,31 @@ int main(void)
             .description = "Open the system editor for the data dump bitmap.",
             .hasArgument = false,
         },
+        (Command) {
+            .name = "policy",
+            .description = "Set the fit policy (0: first-fit, 1: next-fit, 2: best-fit).",
+            .hasArgument = true,
+        },
+        (Command) {
+            .name = "bench",
+            .description = "Compare the fit policies on a workload of the specified number of operations.",
+            .hasArgument = true,
+        },
+        (Command) {
+            .name = "open",
+            .description = "Switch to the persistent heap stored in " HEAP_FILENAME ", creating it if needed.",
+            .hasArgument = false,
+        },
+        (Command) {
+            .name = "close",
+            .description = "Close " HEAP_FILENAME " and switch back to the in-memory heap.",
+            .hasArgument = false,
+        },
+        (Command) {
+            .name = "events",
+            .description = "Write the recorded allocation events to " EVENT_LOG_FILENAME ".",
+            .hasArgument = false,
+        },
         (Command) {
             .name = "help",
             .description = "Show this help menu.",
@@ -82,6 +112,8 @@ int main(void)
 
     showCommandMenu(commands);
 
+    FILE *eventLogFile = NULL;
+
     while (true)
     {
         long long argument = 0;
@@ -108,8 +140,6 @@ int main(void)
                        newAllocation.size, newAllocation.address);
 
                 allocations[allocationCount++] = newAllocation;
-
-                heapDumpChunksBitmap(CHUNKS_DUMP_FILENAME);
             }
 
         }
@@ -135,8 +165,6 @@ int main(void)
                        removedAllocation.size, removedAllocation.address, allocationCount - 1);
 
                 removeAt(allocations, &allocationCount, iRemovedAllocation);
-
-                heapDumpChunksBitmap(CHUNKS_DUMP_FILENAME);
             }
 
         }
@@ -148,13 +176,75 @@ int main(void)
         }
         else if (streq(command->name, "view"))
         {
-            heapDumpChunksBitmap(CHUNKS_DUMP_FILENAME);
-            system(CHUNKS_DUMP_FILENAME);
+            if (heapDumpChunksBitmap(CHUNKS_DUMP_FILENAME))
+            {
+                system(CHUNKS_DUMP_FILENAME);
+            }
         }
         else if (streq(command->name, "data"))
         {
-            heapDumpDataBitmap(DATA_DUMP_FILENAME);
-            system(DATA_DUMP_FILENAME);
+            if (heapDumpDataBitmap(DATA_DUMP_FILENAME))
+            {
+                system(DATA_DUMP_FILENAME);
+            }
+        }
+        else if (streq(command->name, "policy"))
+        {
+            if (argument < 0 || argument >= FIT_POLICY_COUNT)
+            {
+                printf("Invalid fit policy.\n");
+            }
+            else
+            {
+                heapSetFitPolicy((FitPolicy)argument);
+                printf("Fit policy set to %s.\n", fitPolicyName((FitPolicy)argument));
+            }
+        }
+        else if (streq(command->name, "bench"))
+        {
+            if (allocationCount != 0)
+            {
+                printf("Free all allocations before running the benchmark.\n");
+            }
+            else if (argument < 1)
+            {
+                printf("Operation count ('%lld') must be greater than 0.\n", argument);
+            }
+            else
+            {
+                benchmarkFitPolicies((size_t)argument);
+            }
+        }
+        else if (streq(command->name, "open"))
+        {
+            if (allocationCount != 0)
+            {
+                printf("Free all allocations before switching heaps.\n");
+            }
+            else if (heapOpenFile(HEAP_FILENAME))
+            {
+                printf("Opened %s (%zu chunks).\n", HEAP_FILENAME, heapGetStats().chunkCount);
+            }
+        }
+        else if (streq(command->name, "close"))
+        {
+            if (!heapIsFileBacked())
+            {
+                printf("No heap file is open.\n");
+            }
+            else if (allocationCount != 0)
+            {
+                printf("Free all allocations before switching heaps.\n");
+            }
+            else
+            {
+                heapClose();
+                printf("Closed %s.\n", HEAP_FILENAME);
+            }
+        }
+        else if (streq(command->name, "events"))
+        {
+            drainEventLog(&eventLogFile);
         }
         else if (streq(command->name, "help"))
         {
@@ -166,6 +256,12 @@ int main(void)
         }
         else if (streq(command->name, "exit"))
         {
+            if (eventLogFile != NULL)
+            {
+                drainEventLog(&eventLogFile);
+                fclose(eventLogFile);
+            }
+            heapClose();
             break;
         }
         else
@@ -199,4 +295,28 @@ void removeAt(Allocation array[], size_t *count, size_t index)
         array[i] = array[i + 1];
     }
     --(*count);
+}
+
+// Appends the pending allocation events to the event log, creating it on first use.
+void drainEventLog(FILE **file)
+{
+#if HEAP_EVENT_LOG
+    if (*file == NULL)
+    {
+        if (fopen_s(file, EVENT_LOG_FILENAME, "wb") != 0)
+        {
+            printf("Could not open %s.\n", EVENT_LOG_FILENAME);
+            return;
+        }
+        eventLogWriteHeader(*file, heapGetSize());
+    }
+
+    size_t const eventCount = eventLogDrain(*file);
+    fflush(*file);
+
+    printf("Wrote %zu events to %s (%zu dropped).\n", eventCount, EVENT_LOG_FILENAME, eventLogDroppedCount());
+#else
+    (void)file;
+    printf("Event logging is disabled. Build with HEAP_EVENT_LOG=1 to enable it.\n");
+#endif
 }
\ No newline at end of file